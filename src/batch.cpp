@@ -0,0 +1,158 @@
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include "batch.h"
+#include "mcts.h"
+
+template <int N>
+bool parsePosition(const std::string& line, BasicOthello<N>& game) {
+  std::istringstream in{line};
+  std::string squares, turn;
+  if (!(in >> squares >> turn)) return false;
+  if (squares.size() != N * N || turn.size() != 1) return false;
+
+  std::array<std::array<Player, N>, N> board;
+  for (int i = 0; i < squares.size(); i++) {
+    Player& square = board[toRow<N>(i)][toCol<N>(i)];
+    switch (squares[i]) {
+      case 'B': square = Player::black; break;
+      case 'W': square = Player::white; break;
+      case '_': square = Player::none; break;
+      default: return false;
+    }
+  }
+
+  Player whoseTurn;
+  if (turn[0] == 'B') whoseTurn = Player::black;
+  else if (turn[0] == 'W') whoseTurn = Player::white;
+  else return false;
+
+  game = BasicOthello<N>{board, whoseTurn};
+  return true;
+}
+
+static void printMove(std::ostream& out, const std::pair<int, int>& move) {
+  if (isPass(move)) out << "pass";
+  else out << move.first << "," << move.second;
+}
+
+template <int N>
+std::string analysePosition(const std::string& line, int numSims, float c, uint64_t seed) {
+  BasicOthello<N> game;
+  if (!parsePosition(line, game)) return "error";
+  if (isGameOver(game)) return "gameover";
+
+  MCNode<N> root{searchRoot(game, numSims, c, seed)};
+  // c=0: don't explore - just pick the best one
+  int bestMove = selectMove(root, 0);
+
+  std::ostringstream out;
+  printMove(out, root.moves[bestMove]);
+  out << " " << root.moveScores[bestMove];
+  for (int i = 0; i < root.moves.size(); i++) {
+    out << " ";
+    printMove(out, root.moves[i]);
+    out << ":" << root.moveVisits[i];
+  }
+  return out.str();
+}
+
+template <int N>
+void runBatch(std::istream& in, std::ostream& out, int numSims, float c, int numThreads, uint64_t seed) {
+  if (numThreads < 1) numThreads = 1;
+  const size_t window = numThreads * g_batchWindowPerThread;
+
+  // everything below is shared between the reader (this thread), the workers and the writer
+  std::mutex mtx;
+  std::condition_variable jobReady, resultReady, slotFree;
+  std::deque<std::pair<size_t, std::string>> jobs;
+  // finished results waiting for their turn to be written
+  std::map<size_t, std::string> results;
+  size_t numRead = 0, numWritten = 0;
+  bool doneReading = false;
+
+  auto worker = [&]() {
+    while (true) {
+      std::pair<size_t, std::string> job;
+      {
+        std::unique_lock<std::mutex> lock{mtx};
+        jobReady.wait(lock, [&]() { return !jobs.empty() || doneReading; });
+        if (jobs.empty()) return;
+        job = std::move(jobs.front());
+        jobs.pop_front();
+      }
+
+      std::string result;
+      // an exception escaping a worker would take the whole process down - just fail this position
+      try {
+        result = analysePosition<N>(job.second, numSims, c, mixSeed(seed, job.first));
+      } catch (const std::exception& err) {
+        std::cerr << "Position " << job.first << ": " << err.what() << "\n";
+        result = "error";
+      }
+
+      std::lock_guard<std::mutex> lock{mtx};
+      results[job.first] = std::move(result);
+      resultReady.notify_one();
+    }
+  };
+
+  // writes results as soon as the next one in input order is available
+  auto writer = [&]() {
+    std::unique_lock<std::mutex> lock{mtx};
+    while (true) {
+      resultReady.wait(lock, [&]() {
+        return results.count(numWritten) || (doneReading && numWritten == numRead);
+      });
+      if (!results.count(numWritten)) return;
+
+      std::string result{std::move(results[numWritten])};
+      results.erase(numWritten);
+      numWritten++;
+      slotFree.notify_one();
+
+      // don't hold the lock while doing I/O
+      lock.unlock();
+      out << result << "\n";
+      lock.lock();
+    }
+  };
+
+  std::vector<std::thread> workers;
+  for (int i = 0; i < numThreads; i++)
+    workers.emplace_back(worker);
+  std::thread writerThread{writer};
+
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty() || line[0] == '#') continue;
+
+    std::unique_lock<std::mutex> lock{mtx};
+    // stop reading ahead until the writer catches up
+    slotFree.wait(lock, [&]() { return numRead - numWritten < window; });
+    jobs.push_back({numRead++, std::move(line)});
+    jobReady.notify_one();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock{mtx};
+    doneReading = true;
+  }
+  jobReady.notify_all();
+  resultReady.notify_all();
+
+  for (std::thread& t : workers)
+    t.join();
+  writerThread.join();
+  out.flush();
+}
+
+#define INSTANTIATE_BATCH(N) \
+  template bool parsePosition(const std::string& line, BasicOthello<N>& game); \
+  template std::string analysePosition<N>(const std::string& line, int numSims, float c, uint64_t seed); \
+  template void runBatch<N>(std::istream& in, std::ostream& out, int numSims, float c, int numThreads, uint64_t seed);
+OTHELLO_BOARD_SIZES(INSTANTIATE_BATCH)
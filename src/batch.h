@@ -0,0 +1,29 @@
+#ifndef BATCH_H
+#define BATCH_H
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "othello.h"
+
+// max # of positions each worker can have in flight (read but not yet written) - keeps memory bounded on huge inputs
+constexpr int g_batchWindowPerThread{4};
+
+// all of these work on an N x N board
+
+// parses a position line: N^2 squares row by row ('B', 'W' or '_'), whitespace, then the side to move ('B' or 'W')
+// returns false if the line isn't a valid position
+template <int N>
+bool parsePosition(const std::string& line, BasicOthello<N>& game);
+// searches a single position with a playout generator seeded from seed and formats its result line:
+//   <best move> <score> <move>:<visits> ... (one pair per legal move)
+// score = the best move's average playout result, +-sqrt(disc difference) from black's side (positive = black wins) whoever is to move
+// moves are written as row,col or "pass"; finished games give "gameover" and invalid lines "error"
+template <int N>
+std::string analysePosition(const std::string& line, int numSims, float c, uint64_t seed);
+// streams positions (one per line, blank lines and # comments skipped) from in, searches them across numThreads workers and writes one result line per position to out in input order
+// position i is searched with mixSeed(seed, i), so the output doesn't depend on numThreads
+template <int N>
+void runBatch(std::istream& in, std::ostream& out, int numSims, float c, int numThreads, uint64_t seed);
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// minimal unsigned 128-bit integer for boards bigger than 8x8 (MSVC doesn't have a built-in one)
+// only has the operations the move generator needs
+struct UInt128 {
+  uint64_t lo, hi;
+  constexpr UInt128() : lo(0), hi(0) {}
+  constexpr UInt128(uint64_t low) : lo(low), hi(0) {}
+  constexpr UInt128(uint64_t low, uint64_t high) : lo(low), hi(high) {}
+  constexpr explicit operator bool() const { return lo || hi; }
+};
+
+constexpr UInt128 operator&(UInt128 a, UInt128 b) { return {a.lo & b.lo, a.hi & b.hi}; }
+constexpr UInt128 operator|(UInt128 a, UInt128 b) { return {a.lo | b.lo, a.hi | b.hi}; }
+constexpr UInt128 operator^(UInt128 a, UInt128 b) { return {a.lo ^ b.lo, a.hi ^ b.hi}; }
+constexpr UInt128 operator~(UInt128 a) { return {~a.lo, ~a.hi}; }
+constexpr UInt128 operator-(UInt128 a, UInt128 b) { return {a.lo - b.lo, a.hi - b.hi - (a.lo < b.lo)}; }
+constexpr bool operator==(UInt128 a, UInt128 b) { return a.lo == b.lo && a.hi == b.hi; }
+constexpr bool operator!=(UInt128 a, UInt128 b) { return !(a == b); }
+
+constexpr UInt128 operator<<(UInt128 a, int s) {
+  return s == 0 ? a
+    : s < 64 ? UInt128{a.lo << s, (a.hi << s) | (a.lo >> (64 - s))}
+    : UInt128{0, a.lo << (s - 64)};
+}
+
+constexpr UInt128 operator>>(UInt128 a, int s) {
+  return s == 0 ? a
+    : s < 64 ? UInt128{(a.lo >> s) | (a.hi << (64 - s)), a.hi >> s}
+    : UInt128{a.hi >> (s - 64), 0};
+}
+
+inline UInt128& operator&=(UInt128& a, UInt128 b) { return a = a & b; }
+inline UInt128& operator|=(UInt128& a, UInt128 b) { return a = a | b; }
+inline UInt128& operator^=(UInt128& a, UInt128 b) { return a = a ^ b; }
+
+// number of set bits
+inline int popCount(uint64_t bits) {
+#ifdef _MSC_VER
+  return static_cast<int>(__popcnt64(bits));
+#else
+  return __builtin_popcountll(bits);
+#endif
+}
+
+inline int popCount(UInt128 bits) { return popCount(bits.lo) + popCount(bits.hi); }
+
+// index of the lowest set bit - bits must not be 0
+inline int lowestBit(uint64_t bits) {
+#ifdef _MSC_VER
+  unsigned long index;
+  _BitScanForward64(&index, bits);
+  return static_cast<int>(index);
+#else
+  return __builtin_ctzll(bits);
+#endif
+}
+
+inline int lowestBit(UInt128 bits) { return bits.lo ? lowestBit(bits.lo) : 64 + lowestBit(bits.hi); }
+
+// murmur3's 64-bit finalizer - std::hash<uint64_t> is often the identity, which makes nearby positions collide
+inline size_t hashBits(uint64_t bits) {
+  bits = (bits ^ (bits >> 33)) * 0xff51afd7ed558ccdULL;
+  bits = (bits ^ (bits >> 33)) * 0xc4ceb9fe1a85ec53ULL;
+  return static_cast<size_t>(bits ^ (bits >> 33));
+}
+
+inline size_t hashBits(UInt128 bits) { return hashBits(bits.lo) ^ (hashBits(bits.hi) << 1); }
+
+// bitboard type for an N x N board - one bit per square, bit posn = row * N + col
+// a plain 64-bit int up to 8x8 so those sizes don't pay for the 128-bit code
+template <int N>
+using Bitboard = typename std::conditional<N * N <= 64, uint64_t, UInt128>::type;
+
+template <int N>
+constexpr Bitboard<N> squareBit(int posn) { return Bitboard<N>{1} << posn; }
+
+// every square on the board
+template <int N>
+constexpr Bitboard<N> boardMask() {
+  Bitboard<N> mask{0};
+  for (int posn = 0; posn < N * N; posn++)
+    mask = mask | squareBit<N>(posn);
+  return mask;
+}
+
+// every square except the ones in column col
+template <int N>
+constexpr Bitboard<N> notColMask(int col) {
+  Bitboard<N> mask{0};
+  for (int row = 0; row < N; row++) {
+    for (int c = 0; c < N; c++) {
+      if (c != col) mask = mask | squareBit<N>(row * N + c);
+    }
+  }
+  return mask;
+}
+
+// bits as a string of 0s and 1s, highest square first (like std::bitset prints)
+template <int N>
+std::string toBinary(Bitboard<N> bits) {
+  std::string out;
+  for (int posn = N * N - 1; posn >= 0; posn--)
+    out.push_back(bits & squareBit<N>(posn) ? '1' : '0');
+  return out;
+}
+
+#endif
@@ -0,0 +1,64 @@
+#include "engine.h"
+
+template <int N>
+Engine<N>::Engine(float c, uint64_t seed, int expandThreshold)
+  : m_c(c), m_rng(seed), m_tree(m_position, expandThreshold) {}
+
+template <int N>
+void Engine<N>::startSearch(const BasicOthello<N>& position, int maxSims) {
+  stop();
+  m_position = position;
+  m_tree.pruneTo(position);
+  m_numSims = 0;
+  // nothing to search once the game is over
+  if (isGameOver(position)) return;
+
+  m_stop = false;
+  m_done = false;
+  m_thread = std::thread{[this, maxSims]() {
+    // the search thread is the only one touching the tree/rng until it's joined in stop()
+    runSims(m_position, m_tree, m_c, m_rng, maxSims, m_stop, &m_numSims);
+
+    std::lock_guard<std::mutex> lock{m_doneMutex};
+    m_done = true;
+    m_doneCv.notify_all();
+  }};
+}
+
+template <int N>
+std::pair<int, int> Engine<N>::stop() {
+  if (m_thread.joinable()) {
+    m_stop = true;
+    m_thread.join();
+  }
+
+  if (!hasRootNode())
+    return legalMoves(m_position)[0];
+  const MCNode<N>& root{m_tree.getRootNode()};
+  // c=0: don't explore - just pick the best one
+  return root.moves[selectMove(root, 0)];
+}
+
+template <int N>
+std::pair<int, int> Engine<N>::waitAndStop(std::chrono::milliseconds maxTime) {
+  {
+    std::unique_lock<std::mutex> lock{m_doneMutex};
+    m_doneCv.wait_for(lock, maxTime, [this]() { return m_done; });
+  }
+  return stop();
+}
+
+template <int N>
+std::pair<int, int> Engine<N>::searchFor(const BasicOthello<N>& position, int maxSims, std::chrono::milliseconds maxTime) {
+  startSearch(position, maxSims);
+  return waitAndStop(maxTime);
+}
+
+template <int N>
+void Engine<N>::clear() {
+  stop();
+  m_tree.clear();
+}
+
+#define INSTANTIATE_ENGINE(N) template class Engine<N>;
+OTHELLO_BOARD_SIZES(INSTANTIATE_ENGINE)
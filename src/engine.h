@@ -0,0 +1,70 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "mcts.h"
+
+// most sims a single ponder() runs before it stops on its own - the opponent can take as long as they like, but the tree can't keep growing
+constexpr int g_maxPonderSims{250000};
+
+// MCTS player that searches on a background thread and keeps its tree between moves
+// the tree lives as long as the engine (until clear()), so time spent pondering carries over into the next search
+// each new search position drops the part of the tree it can't reach, so only the stats that can still matter are kept
+template <int N = g_boardSize>
+class Engine {
+  private:
+    float m_c;
+    Rng m_rng;
+    // position being searched - declared before m_tree, which is rooted at it
+    BasicOthello<N> m_position;
+    MCTree<N> m_tree;
+    std::thread m_thread;
+    std::atomic<bool> m_stop{false};
+    // set by the search thread once it runs out of sims
+    bool m_done = true;
+    std::mutex m_doneMutex;
+    std::condition_variable m_doneCv;
+    // # of sims the current/last search has run
+    std::atomic<int> m_numSims{0};
+  public:
+    // c = exploitation-exploration constant, seed = seed for every playout the engine runs
+    // expandThreshold = # of visits before a tree node gets its child stats (see MCTree)
+    Engine(float c, uint64_t seed, int expandThreshold = g_expandThreshold);
+    ~Engine() { stop(); }
+    Engine(const Engine&) = delete;
+    Engine& operator=(const Engine&) = delete;
+
+    // stops any running search and starts searching position in the background
+    // maxSims < 0 = keep going until stop()
+    void startSearch(const BasicOthello<N>& position, int maxSims = -1);
+    // keep searching position (usually the one the opponent is thinking about) until the next startSearch/stop or g_maxPonderSims
+    // whatever the opponent plays, the stats gathered for that reply are already in the tree
+    void ponder(const BasicOthello<N>& position) { startSearch(position, g_maxPonderSims); }
+    // stops the search and returns the best move found so far
+    // falls back to the first legal move if the search never got to run
+    std::pair<int, int> stop();
+    // waits until the search finishes its sims or maxTime passes, then stops it and returns the best move
+    std::pair<int, int> waitAndStop(std::chrono::milliseconds maxTime);
+    // blocking search - same as startSearch + waitAndStop
+    std::pair<int, int> searchFor(const BasicOthello<N>& position, int maxSims, std::chrono::milliseconds maxTime);
+
+    // true until the search runs out of sims or is stopped
+    bool isSearching() {
+      std::lock_guard<std::mutex> lock{m_doneMutex};
+      return !m_done;
+    }
+    // # of sims the current/last search has run so far
+    int getNumSims() const { return m_numSims; }
+    // root stats of the last search position - only valid once it's stopped and hasRootNode()
+    // (a root carried over from pondering may still be unexpanded if the search never got to run)
+    bool hasRootNode() { return m_tree.hasRootNode() && m_tree.getRootNode().isExpanded(); }
+    const MCNode<N>& getRootNode() { return m_tree.getRootNode(); }
+    // stops searching and forgets everything in the tree, e.g. for a new game
+    void clear();
+};
+
+#endif
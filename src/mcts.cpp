@@ -1,21 +1,70 @@
 #include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
 #include "mcts.h"
+#include "batch.h"
+#include "nboard.h"
 
-const MCNode MCTree::insertNode(const Othello& game, size_t key) {
-  std::vector<std::pair<int, int>> moves{legalMoves(game)};
-  // init key, whoseTurn, numVisits, moves vector
-  // and manually resize other two vectors to match
-  MCNode newNode{ key, game.getWhoseTurn(), 0, moves };
-  newNode.moveVisits.resize(moves.size());
-  newNode.moveScores.resize(moves.size());
+template <int N>
+MCNode<N>& MCTree<N>::insertNode(const BasicOthello<N>& game, size_t key) {
+  // init key, whoseTurn, numVisits, legal-move mask
+  // the moves + stats vectors stay empty until the node is expanded
+  MCNode<N> newNode{ key, game.getWhoseTurn(), 0, legalMoveMask(game) };
+  expandIfReady(newNode);
   m_hashy.insert(key, newNode);
-  return newNode;
+  return m_hashy.get(key);
 }
 
-std::ostream& operator<<(std::ostream& out, const MCNode& node) {
+template <int N>
+void MCTree<N>::pruneTo(const BasicOthello<N>& game) {
+  if (game.getHashKey() == m_rootKey) return;
+  setRoot(game);
+
+  // walk down from the new root through every position that's in the tree and copy it over
+  HashTable<MCNode<N>> kept{};
+  std::vector<BasicOthello<N>> stack{game};
+  while (!stack.empty()) {
+    BasicOthello<N> position{stack.back()};
+    stack.pop_back();
+    size_t key = position.getHashKey();
+    // transpositions get reached more than once
+    if (!m_hashy.contains(key) || kept.contains(key)) continue;
+
+    const MCNode<N>& node{m_hashy.get(key)};
+    kept.insert(key, node);
+
+    // the mask covers unexpanded nodes too, whose children can still be in the tree through other parents
+    for (const std::pair<int, int>& move : movesFromMask<N>(node.legalMask)) {
+      BasicOthello<N> child{position};
+      stack.push_back(doMove(child, false, move.first, move.second));
+    }
+  }
+  m_hashy = std::move(kept);
+}
+
+template <int N>
+void expandNode(MCNode<N>& node) {
+  // same order as legalMoves, which visit distributions and records rely on
+  node.moves = movesFromMask<N>(node.legalMask);
+  node.moveVisits.resize(node.moves.size());
+  node.moveScores.resize(node.moves.size());
+}
+
+template <int N>
+std::ostream& operator<<(std::ostream& out, const MCNode<N>& node) {
   out << "Key: " << node.key << "\n";
   out << "Whose turn: " << node.whoseTurn << "\n";
   out << "Visits: " << node.numVisits << "\n";
+  if (!node.isExpanded()) {
+    out << "Unexpanded, legal moves: " << toBinary<N>(node.legalMask) << "\n";
+    return out;
+  }
   out << "Moves:\n";
   for (int i = 0; i < node.moves.size(); i++) {
     out << "  [" << node.moves[i].first << ", " << node.moves[i].second << "]";
@@ -24,7 +73,21 @@ std::ostream& operator<<(std::ostream& out, const MCNode& node) {
   return out;
 }
 
-int selectMove(const MCNode& node, float c) {
+template <int N>
+int selectMove(const MCNode<N>& node, float c, Rng& rng, std::pair<int, int>& move) {
+  // no child stats yet - any legal move is as good as another
+  if (!node.isExpanded()) {
+    move = randomMove<N>(node.legalMask, rng);
+    return g_unexpandedMove;
+  }
+
+  int moveIdx = selectMove(node, c);
+  move = node.moves[moveIdx];
+  return moveIdx;
+}
+
+template <int N>
+int selectMove(const MCNode<N>& node, float c) {
   const Player& player = node.whoseTurn;
   int numMoves = node.moves.size();
 
@@ -64,14 +127,16 @@ int selectMove(const MCNode& node, float c) {
   }
 }
 
-std::vector<std::pair<size_t, int>> simTree(Othello& game, MCTree& tree, float c) {
+template <int N>
+std::vector<std::pair<size_t, int>> simTree(BasicOthello<N>& game, MCTree<N>& tree, float c, Rng& rng) {
   std::vector<std::pair<size_t, int>> kmAcc;
 
   // select a move, do it and update the game/accumulator
-  auto pickMoveAndPush = [&](Othello& game, const MCNode& node, size_t key) {
-      int moveIdx = selectMove(node, c);
+  auto pickMoveAndPush = [&](BasicOthello<N>& game, const MCNode<N>& node, size_t key) {
+      std::pair<int, int> move;
+      int moveIdx = selectMove(node, c, rng, move);
 
-      game = doMove(game, false, node.moves[moveIdx].first, node.moves[moveIdx].second);
+      game = doMove(game, false, move.first, move.second);
       kmAcc.push_back({key, moveIdx});
   };
 
@@ -79,7 +144,12 @@ std::vector<std::pair<size_t, int>> simTree(Othello& game, MCTree& tree, float c
     size_t key = game.getHashKey();
     // if key is already in tree, pick a new move
     try {
-      pickMoveAndPush(game, tree.getHashTable().get(key), key);
+      MCNode<N>& node{tree.getHashTable().get(key)};
+      // second visit (by default) = worth tracking its children now
+      tree.expandIfReady(node);
+      pickMoveAndPush(game, node, key);
+      // no child stats to follow yet - roll out from here instead of adding its children under it
+      if (!node.isExpanded()) break;
     }
     // if we haven't seen it before, add node and stop the simulation
     catch (std::invalid_argument) {
@@ -94,16 +164,19 @@ std::vector<std::pair<size_t, int>> simTree(Othello& game, MCTree& tree, float c
   return kmAcc;
 }
 
-void backUp(HashTable<MCNode>& hashy, const std::vector<std::pair<size_t, int>>& kmAcc, float result) {
+template <int N>
+void backUp(HashTable<MCNode<N>>& hashy, const std::vector<std::pair<size_t, int>>& kmAcc, float result) {
   for (std::pair<size_t, int> keyMove : kmAcc) {
     size_t key = keyMove.first;
     int move = keyMove.second;
 
     try {
-      MCNode& node{hashy.get(key)};
+      MCNode<N>& node{hashy.get(key)};
 
       // update stats on each node from each key/move pair
       node.numVisits++;
+      // unexpanded nodes only count visits
+      if (move == g_unexpandedMove) continue;
       node.moveVisits[move]++;
       node.moveScores[move] += 
         (result - node.moveScores[move]) / node.moveVisits[move];
@@ -116,24 +189,40 @@ void backUp(HashTable<MCNode>& hashy, const std::vector<std::pair<size_t, int>>&
   }
 }
 
-std::pair<int, int> uctSearch(const Othello& origGame, int numSims, float c, bool verbose) {
-  std::cout << "==========================\n";
-  std::cout << "        UCT Search\n";
-  std::cout << "==========================\n";
-  
-  MCTree tree{origGame};
-
-  for (int i = 0; i < numSims; i++) {
+template <int N>
+int runSims(const BasicOthello<N>& origGame, MCTree<N>& tree, float c, Rng& rng, int numSims, const std::atomic<bool>& stop, std::atomic<int>* simCount) {
+  int i;
+  for (i = 0; (numSims < 0 || i < numSims) && !stop; i++) {
+    if (simCount) *simCount = i;
     // clone the game and do a bunch of simulations
-    Othello copy{origGame};
-    std::vector<std::pair<size_t, int>> keyMoveAcc{simTree(copy, tree, c)};
-    float result = simDefault(copy);
+    BasicOthello<N> copy{origGame};
+    std::vector<std::pair<size_t, int>> keyMoveAcc{simTree(copy, tree, c, rng)};
+    float result = simDefault(copy, rng);
 
     backUp(tree.getHashTable(), keyMoveAcc, result);
   }
-    
-  // afterwards, find best move and print results
-  MCNode root{tree.getRootNode()};
+  if (simCount) *simCount = i;
+  return i;
+}
+
+template <int N>
+MCNode<N> searchRoot(const BasicOthello<N>& origGame, int numSims, float c, uint64_t seed, int expandThreshold) {
+  MCTree<N> tree{origGame, expandThreshold};
+  Rng rng{seed};
+  std::atomic<bool> never{false};
+
+  runSims(origGame, tree, c, rng, numSims, never);
+  return tree.getRootNode();
+}
+
+template <int N>
+std::pair<int, int> uctSearch(const BasicOthello<N>& origGame, int numSims, float c, bool verbose, uint64_t seed) {
+  std::cout << "==========================\n";
+  std::cout << "        UCT Search\n";
+  std::cout << "==========================\n";
+  
+  // run the simulations, then find best move and print results
+  MCNode<N> root{searchRoot(origGame, numSims, c, seed)};
   // c=0: don't explore - just pick the best one
   int bestMove = selectMove(root, 0); 
   float bestScore = root.moveScores[bestMove];
@@ -153,17 +242,21 @@ std::pair<int, int> uctSearch(const Othello& origGame, int numSims, float c, boo
   return root.moves[bestMove];
 }
 
-void compete(int blackSims, float blackC, int whiteSims, int whiteC, bool verbose) {
-  Othello game;
+template <int N>
+void compete(int blackSims, float blackC, int whiteSims, int whiteC, bool verbose, uint64_t seed) {
+  BasicOthello<N> game;
+  // each search gets its own seed from this one
+  Rng seeds{seed};
+  std::cout << "Seed: " << seed << "\n";
 
   while (!isGameOver(game)) {
     std::pair<int, int> move;
     if (game.getWhoseTurn() == Player::black) {
       std::cout << "\nBLACK'S TURN!\n";
-      move = uctSearch(game, blackSims, blackC, verbose);
+      move = uctSearch(game, blackSims, blackC, verbose, seeds.next());
     } else {
       std::cout << "\nWHITE'S TURN!\n";
-      move = uctSearch(game, whiteSims, whiteC, verbose);
+      move = uctSearch(game, whiteSims, whiteC, verbose, seeds.next());
     }
     doMove(game, false, move.first, move.second);
     if (verbose) 
@@ -185,6 +278,198 @@ void compete(int blackSims, float blackC, int whiteSims, int whiteC, bool verbos
   }
 }
 
-int main() {
-  compete(1000, 2, 1000, 2, true);
-}
\ No newline at end of file
+template <int N>
+GameRecord playGame(int blackSims, float blackC, int whiteSims, float whiteC, bool recordVisits, uint64_t seed) {
+  GameRecord record{blackSims, blackC, whiteSims, whiteC};
+  BasicOthello<N> game;
+  Rng seeds{seed};
+
+  while (!isGameOver(game)) {
+    bool blackTurn = game.getWhoseTurn() == Player::black;
+    MCNode<N> root{blackTurn ? searchRoot(game, blackSims, blackC, seeds.next()) : searchRoot(game, whiteSims, whiteC, seeds.next())};
+    // c=0: don't explore - just pick the best one
+    std::pair<int, int> move{root.moves[selectMove(root, 0)]};
+
+    record.moves.push_back(toRecordSquare(move, N));
+    if (recordVisits)
+      record.visits.push_back(root.moveVisits);
+    doMove(game, false, move.first, move.second);
+  }
+
+  record.pieces = game.getTotalPieces();
+  record.seed = seed;
+  return record;
+}
+
+template <int N>
+void selfPlay(int numGames, int numSims, float c, int numThreads, bool recordVisits, GameRecordWriter& writer, uint64_t seed) {
+  if (writer.getBoardSize() != N)
+    throw std::invalid_argument("Record file is for a different board size!");
+  if (numThreads < 1) numThreads = 1;
+  std::atomic<int> nextGame{0};
+  // first failed write - rethrown once every thread is done
+  std::exception_ptr error;
+  std::mutex errorMutex;
+
+  auto player = [&]() {
+    int i;
+    try {
+      while ((i = nextGame++) < numGames) {
+        GameRecord record{playGame<N>(numSims, c, numSims, c, recordVisits, mixSeed(seed, i))};
+        record.index = i;
+        writer.append(record);
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock{errorMutex};
+      if (!error) error = std::current_exception();
+      // no point playing games that can't be stored
+      nextGame = numGames;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < numThreads; i++)
+    threads.emplace_back(player);
+  for (std::thread& t : threads)
+    t.join();
+  if (error) std::rethrow_exception(error);
+  writer.flush();
+}
+
+#define INSTANTIATE_MCTS(N) \
+  template class MCTree<N>; \
+  template int selectMove(const MCNode<N>& node, float c); \
+  template std::ostream& operator<<(std::ostream& out, const MCNode<N>& node); \
+  template int runSims(const BasicOthello<N>& origGame, MCTree<N>& tree, float c, Rng& rng, int numSims, const std::atomic<bool>& stop, std::atomic<int>* simCount); \
+  template MCNode<N> searchRoot(const BasicOthello<N>& origGame, int numSims, float c, uint64_t seed, int expandThreshold); \
+  template std::pair<int, int> uctSearch(const BasicOthello<N>& origGame, int numSims, float c, bool verbose, uint64_t seed); \
+  template void compete<N>(int blackSims, float blackC, int whiteSims, int whiteC, bool verbose, uint64_t seed); \
+  template GameRecord playGame<N>(int blackSims, float blackC, int whiteSims, float whiteC, bool recordVisits, uint64_t seed); \
+  template void selfPlay<N>(int numGames, int numSims, float c, int numThreads, bool recordVisits, GameRecordWriter& writer, uint64_t seed);
+OTHELLO_BOARD_SIZES(INSTANTIATE_MCTS)
+
+// every mode takes an optional seed as its last argument - runs with the same seed (and settings) give the same results
+// without one, a fresh seed is drawn and printed to stderr so the run can be reproduced
+static uint64_t seedArg(int argc, char* argv[], int index) {
+  if (argc > index)
+    return std::strtoull(argv[index], nullptr, 10);
+  uint64_t seed = (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
+  std::cerr << "Seed: " << seed << "\n";
+  return seed;
+}
+
+// replays every game in reader and prints its final board
+template <int N>
+static void printReplays(GameRecordReader& reader) {
+  GameRecordView record;
+  for (int i = 0; reader.next(record); i++) {
+    std::cout << "\nGame " << i << " (#" << record.index << ", seed " << record.seed << "): " << record.numMoves << " moves, B "
+              << record.blackSims << " sims/c=" << record.blackC << " vs W "
+              << record.whiteSims << " sims/c=" << record.whiteC << "\n";
+    std::cout << replayGame<N>(record);
+  }
+}
+
+// runs the mode picked on the command line on an N x N board
+template <int N>
+static int runMain(int argc, char* argv[]) {
+  // batch mode: othello batch [numSims] [c] [numThreads] [file] [seed]
+  // reads positions from file (or stdin if missing/"-") and writes one result line per position
+  if (argc > 1 && std::string(argv[1]) == "batch") {
+    int numSims = argc > 2 ? std::atoi(argv[2]) : 1000;
+    float c = argc > 3 ? std::atof(argv[3]) : 2;
+    int numThreads = argc > 4 ? std::atoi(argv[4]) : std::thread::hardware_concurrency();
+    if (numSims < 1) {
+      std::cerr << "numSims must be at least 1!\n";
+      return 1;
+    }
+
+    if (argc > 5 && std::string(argv[5]) != "-") {
+      std::ifstream file{argv[5]};
+      if (!file) {
+        std::cerr << "Couldn't open " << argv[5] << "!\n";
+        return 1;
+      }
+      runBatch<N>(file, std::cout, numSims, c, numThreads, seedArg(argc, argv, 6));
+    } else {
+      runBatch<N>(std::cin, std::cout, numSims, c, numThreads, seedArg(argc, argv, 6));
+    }
+    return 0;
+  }
+
+  // self-play mode: othello selfplay [numGames] [numSims] [c] [numThreads] [file] [seed]
+  // appends every game (with root visit distributions) to a binary record file
+  if (argc > 1 && std::string(argv[1]) == "selfplay") {
+    int numGames = argc > 2 ? std::atoi(argv[2]) : 10;
+    int numSims = argc > 3 ? std::atoi(argv[3]) : 1000;
+    float c = argc > 4 ? std::atof(argv[4]) : 2;
+    int numThreads = argc > 5 ? std::atoi(argv[5]) : std::thread::hardware_concurrency();
+    std::string path{argc > 6 ? argv[6] : "games.orec"};
+    if (numSims < 1) {
+      std::cerr << "numSims must be at least 1!\n";
+      return 1;
+    }
+
+    try {
+      GameRecordWriter writer{path, N};
+      selfPlay<N>(numGames, numSims, c, numThreads, true, writer, seedArg(argc, argv, 7));
+    } catch (std::runtime_error err) {
+      std::cerr << err.what() << "\n";
+      return 1;
+    }
+    return 0;
+  }
+
+  // engine mode: othello nboard [c] [seed]
+  // talks the NBoard protocol over stdin/stdout, pondering between requests
+  if (argc > 1 && std::string(argv[1]) == "nboard") {
+    float c = argc > 2 ? std::atof(argv[2]) : 2;
+    runNBoard<N>(std::cin, std::cout, c, seedArg(argc, argv, 3));
+    return 0;
+  }
+
+  // default: othello [seed]
+  uint64_t seed = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::random_device{}();
+  compete<N>(1000, 2, 1000, 2, true, seed);
+  return 0;
+}
+
+int main(int argc, char* argv[]) {
+  // othello [--size N] ... - plays on an N x N board (any size in OTHELLO_BOARD_SIZES) instead of 8x8
+  int boardSize = g_boardSize;
+  if (argc > 2 && std::string(argv[1]) == "--size") {
+    boardSize = std::atoi(argv[2]);
+    // drop the option so the modes see the same arguments either way
+    argv[2] = argv[0];
+    argv += 2;
+    argc -= 2;
+  }
+
+  // replay mode: othello replay [file]
+  // replays every game in a record file and prints its final board - the board size comes from the file
+  if (argc > 1 && std::string(argv[1]) == "replay") {
+    std::string path{argc > 2 ? argv[2] : "games.orec"};
+
+    try {
+      GameRecordReader reader{path};
+      boardSize = reader.getBoardSize();
+      switch (boardSize) {
+#define REPLAY_SIZE(N) case N: printReplays<N>(reader); return 0;
+        OTHELLO_BOARD_SIZES(REPLAY_SIZE)
+#undef REPLAY_SIZE
+      }
+    } catch (std::runtime_error err) {
+      std::cerr << err.what() << "\n";
+      return 1;
+    }
+  } else {
+    switch (boardSize) {
+#define RUN_SIZE(N) case N: return runMain<N>(argc, argv);
+      OTHELLO_BOARD_SIZES(RUN_SIZE)
+#undef RUN_SIZE
+    }
+  }
+
+  std::cerr << "Unsupported board size " << boardSize << "!\n";
+  return 1;
+}
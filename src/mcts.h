@@ -1,54 +1,121 @@
 #ifndef MCTS_H
 #define MCTS_H
 
+#include <atomic>
 #include "othello.h"
 #include "othello-rules.h"
 #include "hash-table.h"
+#include "record.h"
 
 // for weighting unexplored nodes/moves without overflow
 constexpr float g_posInfinity{10000000};
 constexpr float g_posInfinityInverse{1 / g_posInfinity};
+// # of visits before a node gets its child stats - until then it only keeps its legal-move mask
+// most leaves are only ever visited once, so this saves expanding them at all (0 = expand straight away)
+constexpr int g_expandThreshold{1};
+// move index backUp gets for a node that wasn't expanded yet (no child stats to update)
+constexpr int g_unexpandedMove{-1};
 
+template <int N>
 struct MCNode {
   size_t key;
   Player whoseTurn;
   int numVisits = 0;
+  // squares the player to move can play - all an unexpanded node has
+  Bitboard<N> legalMask{0};
+  // child stats - empty until the node is expanded
   std::vector<std::pair<int, int>> moves;
   std::vector<int> moveVisits;
   std::vector<float> moveScores;
+
+  // every expanded node has at least one move (maybe a pass)
+  bool isExpanded() const { return !moves.empty(); }
 };
 
-std::ostream& operator<<(std::ostream& out, const MCNode& node);
+template <int N>
+std::ostream& operator<<(std::ostream& out, const MCNode<N>& node);
+
+// fills in a node's moves (in the same order as legalMoves) and zeroed stats from its legal-move mask
+template <int N>
+void expandNode(MCNode<N>& node);
 
+template <int N>
 class MCTree {
   private:
-    HashTable<MCNode> m_hashy{};
+    HashTable<MCNode<N>> m_hashy{};
     size_t m_rootKey;
+    int m_expandThreshold;
   public:
     // tree root state derived from game
-    MCTree(const Othello& game) : m_rootKey(game.getHashKey()) {}
-    HashTable<MCNode>& getHashTable() { return m_hashy; }
-    const MCNode& getRootNode() { return m_hashy.get(m_rootKey); }
-    // creates a new node and inserts it into the tree
-    const MCNode insertNode(const Othello& game, size_t key);
+    // nodes get expanded once they've been visited expandThreshold times (the root always is)
+    MCTree(const BasicOthello<N>& game, int expandThreshold = g_expandThreshold)
+      : m_rootKey(game.getHashKey()), m_expandThreshold(expandThreshold) {}
+    HashTable<MCNode<N>>& getHashTable() { return m_hashy; }
+    // nodes are keyed by position, so moving the root keeps whatever was already learned about the new root's subtree
+    void setRoot(const BasicOthello<N>& game) { m_rootKey = game.getHashKey(); }
+    // same as setRoot, but also drops every node that can't be reached from the new root (e.g. after a move is played)
+    void pruneTo(const BasicOthello<N>& game);
+    bool hasRootNode() { return m_hashy.contains(m_rootKey); }
+    const MCNode<N>& getRootNode() { return m_hashy.get(m_rootKey); }
+    // drops every node, e.g. when starting a new game
+    void clear() { m_hashy = HashTable<MCNode<N>>{}; }
+    // creates a new (unexpanded unless it's the root) node, inserts it into the tree and returns it
+    MCNode<N>& insertNode(const BasicOthello<N>& game, size_t key);
+    // expands node if it's been visited enough (or is the root) and isn't already
+    void expandIfReady(MCNode<N>& node) {
+      if (!node.isExpanded() && (node.numVisits >= m_expandThreshold || node.key == m_rootKey))
+        expandNode(node);
+    }
 };
 
 // selects an index into the node's moves vector, weighing explored high-scoring actions against unexplored ones as determined by c (the exploitation-exploration constant)
-// throws a std::out_of_range exception if there are no moves
-int selectMove(const MCNode& node, float c);
-// explores a path from the root node down to a yet-unexplored node and returns a list of (state, move) pairs
+// an unexpanded node has no child stats to weigh, so its move is drawn straight from its legal-move mask with rng and g_unexpandedMove is returned in its place - move is set either way
+// throws a std::out_of_range exception if an expanded node has no moves
+template <int N>
+int selectMove(const MCNode<N>& node, float c, Rng& rng, std::pair<int, int>& move);
+// same as above for nodes that are known to be expanded, e.g. the root when picking the final move
+template <int N>
+int selectMove(const MCNode<N>& node, float c);
+// explores a path from the root node down to a yet-unexplored node (or one that isn't expanded yet) and returns a list of (state, move) pairs
 // state = a key into the tree's hash table of nodes
-// move = an index into the moves vector of the corresponding node
-std::vector<std::pair<size_t, int>> simTree(Othello& game, MCTree& tree, float c);
+// move = an index into the moves vector of the corresponding node (g_unexpandedMove if it wasn't expanded)
+template <int N>
+std::vector<std::pair<size_t, int>> simTree(BasicOthello<N>& game, MCTree<N>& tree, float c, Rng& rng);
 // explore a path using the default policy (random moves)
-float simDefault(Othello& game) { return defaultPolicy(game); }
+template <int N>
+inline float simDefault(BasicOthello<N>& game, Rng& rng) { return defaultPolicy(game, rng); }
 // update the relevant nodes in the hash table with a list of (key, move) accumulated pairs from a simulation run and the final score
-void backUp(HashTable<MCNode>& hashy, const std::vector<std::pair<size_t, int>>& kmAcc, float result);
+template <int N>
+void backUp(HashTable<MCNode<N>>& hashy, const std::vector<std::pair<size_t, int>>& kmAcc, float result);
+// runs simulations from origGame into tree until numSims have run (no limit if numSims < 0) or stop gets set, and returns how many ran
+// if simCount is given, it's kept up to date with the # of finished sims so other threads can watch the search's progress
+template <int N>
+int runSims(const BasicOthello<N>& origGame, MCTree<N>& tree, float c, Rng& rng, int numSims, const std::atomic<bool>& stop, std::atomic<int>* simCount = nullptr);
+// runs numSims simulations from origGame without printing anything and returns a copy of the root node's stats
+// the playouts draw from a generator seeded with seed, so the same seed always gives the same result
+// expandThreshold = # of visits before a node gets its child stats (see MCTree)
+template <int N>
+MCNode<N> searchRoot(const BasicOthello<N>& origGame, int numSims, float c, uint64_t seed, int expandThreshold = g_expandThreshold);
 // uses the MCTS algorithm with the given parameters to estimate the best possible move for the current game state
-std::pair<int, int> uctSearch(const Othello& origGame, int numSims, float C, bool verbose);
+template <int N>
+std::pair<int, int> uctSearch(const BasicOthello<N>& origGame, int numSims, float C, bool verbose, uint64_t seed);
+
+// the game functions below play on an N x N board, e.g. compete<6>(...) - plain calls use the standard 8x8 board
 
 // pit two players against each other with different UCT search args
 // verbose = whether or not to print out the entire game as it progresses
-void compete(int blackSims, float blackC, int whiteSims, int whiteC, bool verbose);
+// seed = base seed every search in the game is derived from
+template <int N = g_boardSize>
+void compete(int blackSims, float blackC, int whiteSims, int whiteC, bool verbose, uint64_t seed);
+// plays one game between two players without printing anything and returns its record
+// recordVisits = whether to also store the root visit distribution before every move
+template <int N = g_boardSize>
+GameRecord playGame(int blackSims, float blackC, int whiteSims, float whiteC, bool recordVisits, uint64_t seed);
+// plays numGames self-play games across numThreads threads, appending each to writer as soon as it's done
+// game i is seeded with mixSeed(seed, i), so the games don't depend on how they were spread across threads
+// they're stored in the order they finish, each with its index i and seed so it can be matched up and replayed
+// throws std::runtime_error if the games can't be written
+template <int N = g_boardSize>
+void selfPlay(int numGames, int numSims, float c, int numThreads, bool recordVisits, GameRecordWriter& writer, uint64_t seed);
 
 #endif
\ No newline at end of file
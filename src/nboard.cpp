@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include "nboard.h"
+#include "engine.h"
+
+template <int N>
+std::string toMoveName(const std::pair<int, int>& move) {
+  if (isPass(move)) return "PA";
+  return std::string(1, 'A' + move.second) + std::to_string(move.first + 1);
+}
+
+template <int N>
+bool fromMoveName(const std::string& name, std::pair<int, int>& move) {
+  if (name.size() < 2) return false;
+  if (std::toupper(name[0]) == 'P' && std::toupper(name[1]) == 'A') {
+    move = g_movePass;
+    return true;
+  }
+
+  int col = std::toupper(name[0]) - 'A';
+  int row = std::atoi(name.c_str() + 1) - 1;
+  if (!inBounds<N>(row, col)) return false;
+  move = {row, col};
+  return true;
+}
+
+// helper to check a move against the legal ones before doing it - doMove's own check prints to stdout, which is the protocol channel here
+template <int N>
+static bool isLegalMove(const BasicOthello<N>& game, const std::pair<int, int>& move) {
+  std::vector<std::pair<int, int>> moves{legalMoves(game)};
+  return std::find(moves.begin(), moves.end(), move) != moves.end();
+}
+
+template <int N>
+bool parseGgf(const std::string& ggf, BasicOthello<N>& game) {
+  bool haveBoard = false;
+
+  // walk through every TAG[value] pair
+  for (size_t open = ggf.find('['); open != std::string::npos; open = ggf.find('[', open + 1)) {
+    size_t close = ggf.find(']', open);
+    if (close == std::string::npos) return false;
+    // the tag is the run of capital letters right before the '[' (so PB[...] isn't mistaken for B[...])
+    size_t start = open;
+    while (start > 0 && std::isupper(ggf[start - 1])) start--;
+    std::string tag{ggf.substr(start, open - start)};
+    std::string value{ggf.substr(open + 1, close - open - 1)};
+
+    if (tag == "BO") {
+      // BO[<size> <squares, maybe split into rows> <side to move>] with - = empty, * = black, O = white
+      std::istringstream in{value};
+      int size;
+      std::string squares, part;
+      if (!(in >> size) || size != N) return false;
+      while (in >> part) squares += part;
+      if (squares.size() != N * N + 1) return false;
+
+      std::array<std::array<Player, N>, N> board;
+      for (int i = 0; i < N * N; i++) {
+        Player& square = board[toRow<N>(i)][toCol<N>(i)];
+        switch (squares[i]) {
+          case '-': square = Player::none; break;
+          case '*': square = Player::black; break;
+          case 'O': square = Player::white; break;
+          default: return false;
+        }
+      }
+      char side = squares.back();
+      if (side != '*' && side != 'O') return false;
+
+      game = BasicOthello<N>{board, side == '*' ? Player::black : Player::white};
+      haveBoard = true;
+    } else if ((tag == "B" || tag == "W") && haveBoard) {
+      // B[<move>/<eval>/<time>] - only the move matters
+      std::pair<int, int> move;
+      if (!fromMoveName<N>(value.substr(0, value.find('/')), move)) return false;
+      // some files leave out passes, so trust the tag over whose turn we think it is
+      Player player = tag == "B" ? Player::black : Player::white;
+      if (game.getWhoseTurn() != player) game.togglePlayer();
+      if (!isLegalMove(game, move)) return false;
+      doMove(game, false, move.first, move.second);
+    }
+
+    open = close;
+  }
+  return haveBoard;
+}
+
+template <int N>
+void runNBoard(std::istream& in, std::ostream& out, float c, uint64_t seed) {
+  Engine<N> engine{c, seed};
+  BasicOthello<N> game;
+  int depth = 1;
+
+  // every reply goes out straight away - the GUI is waiting on it
+  auto say = [&](const std::string& line) { out << line << std::endl; };
+
+  // searches the current position and returns the best move + its score from the mover's point of view (roughly in discs)
+  auto think = [&]() -> std::pair<std::pair<int, int>, float> {
+    if (isGameOver(game)) return {g_movePass, 0};
+    std::pair<int, int> best{engine.searchFor(game, depth * g_simsPerDepth, g_maxMoveTime)};
+    if (!engine.hasRootNode()) return {best, 0};
+
+    const MCNode<N>& root{engine.getRootNode()};
+    int bestIndex = std::find(root.moves.begin(), root.moves.end(), best) - root.moves.begin();
+    // scores are +-sqrt(disc difference) from black's side
+    float score = root.moveScores[bestIndex];
+    float discs = score * std::abs(score);
+    return {best, game.getWhoseTurn() == Player::black ? discs : -discs};
+  };
+
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream cmd{line};
+    std::string word;
+    cmd >> word;
+
+    if (word == "nboard") {
+      say("set myname othello-cpp");
+    } else if (word == "set") {
+      std::string what;
+      cmd >> what;
+      if (what == "depth") {
+        int newDepth;
+        if (cmd >> newDepth && newDepth > 0) depth = newDepth;
+      } else if (what == "game") {
+        std::string ggf;
+        std::getline(cmd, ggf);
+        BasicOthello<N> newGame;
+        if (parseGgf(ggf, newGame)) {
+          // new game = old tree is no use
+          engine.clear();
+          game = newGame;
+          engine.ponder(game);
+        } else {
+          std::cerr << "Couldn't read game: " << ggf << "\n";
+        }
+      }
+    } else if (word == "move") {
+      std::string name;
+      cmd >> name;
+      std::pair<int, int> move;
+      if (fromMoveName<N>(name.substr(0, name.find('/')), move) && isLegalMove(game, move)) {
+        engine.stop();
+        doMove(game, false, move.first, move.second);
+        engine.ponder(game);
+      } else {
+        std::cerr << "Ignoring illegal move " << name << "\n";
+      }
+    } else if (word == "go") {
+      std::pair<std::pair<int, int>, float> result{think()};
+      say("=== " + toMoveName<N>(result.first));
+      // the GUI sends our move back before anything else happens, so spend the wait on the opponent's replies to it
+      BasicOthello<N> afterReply{game};
+      doMove(afterReply, false, result.first.first, result.first.second);
+      engine.ponder(afterReply);
+    } else if (word == "hint") {
+      std::pair<std::pair<int, int>, float> result{think()};
+      std::ostringstream reply;
+      reply << "search " << toMoveName<N>(result.first) << " " << result.second << " 0 " << depth;
+      say(reply.str());
+      engine.ponder(game);
+    } else if (word == "ping") {
+      std::string n;
+      cmd >> n;
+      say("pong " + n);
+    } else if (word == "learn") {
+      say("learned");
+    } else if (word == "quit") {
+      break;
+    }
+  }
+  engine.stop();
+}
+
+#define INSTANTIATE_NBOARD(N) \
+  template std::string toMoveName<N>(const std::pair<int, int>& move); \
+  template bool fromMoveName<N>(const std::string& name, std::pair<int, int>& move); \
+  template bool parseGgf(const std::string& ggf, BasicOthello<N>& game); \
+  template void runNBoard<N>(std::istream& in, std::ostream& out, float c, uint64_t seed);
+OTHELLO_BOARD_SIZES(INSTANTIATE_NBOARD)
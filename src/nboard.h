@@ -0,0 +1,30 @@
+#ifndef NBOARD_H
+#define NBOARD_H
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "othello.h"
+
+// NBoard asks for a search depth - each ply of it is worth this many sims to us
+constexpr int g_simsPerDepth{2000};
+// hard cap on how long a single move can take, whatever the depth
+constexpr std::chrono::milliseconds g_maxMoveTime{10000};
+
+// converts a move to NBoard's square name (column letter + 1-based row, e.g. "F5", "PA" for a pass)
+template <int N>
+std::string toMoveName(const std::pair<int, int>& move);
+// the other way around - returns false if name isn't a square on an N x N board
+template <int N>
+bool fromMoveName(const std::string& name, std::pair<int, int>& move);
+// reads the starting board (BO) and moves (B/W) out of a GGF game and plays them
+// returns false if the game can't be read or isn't on an N x N board
+template <int N>
+bool parseGgf(const std::string& ggf, BasicOthello<N>& game);
+// talks the NBoard engine protocol over in/out until "quit" or the end of input
+// supports nboard, set depth, set game, move, go, hint, ping, learn and quit - anything else is ignored
+// the engine ponders whenever it's not answering a request
+template <int N>
+void runNBoard(std::istream& in, std::ostream& out, float c, uint64_t seed);
+
+#endif
@@ -1,64 +1,61 @@
-#include <cassert>
-#include <random>
+#include <cmath>
+#include <cstdlib>
 #include "othello-rules.h"
 
-// helper to determine if a given row/col move is legal for the game
-static bool isLegal(const Othello& game, int row, int col) {
-  // don't call this function with the "pass" move!
-  assert(!isPass({row, col}));
+// helper that finds every square own can move to against opp
+// walks runs of opp's pieces out from own's in each direction and keeps the empty square at the end of each run
+template <int N>
+static Bitboard<N> legalMoveMask(Bitboard<N> own, Bitboard<N> opp) {
+  constexpr Bitboard<N> board{boardMask<N>()};
+  Bitboard<N> empty = board & ~(own | opp);
+  Bitboard<N> moves{0};
+
+  for (int dir = 0; dir < g_flipDirs.size(); dir++) {
+    Bitboard<N> run = shiftDir<N>(own, dir) & opp;
+    // a run of flippable pieces is at most N - 2 long
+    for (int i = 0; i < N - 3; i++)
+      run |= shiftDir<N>(run, dir) & opp;
+    moves |= shiftDir<N>(run, dir) & empty;
+  }
+  return moves;
+}
 
-  MoveCheckStatus status;
-  const Player& player = game.getWhoseTurn();
-  const std::array<std::array<Player, g_boardSize>, g_boardSize>& board = game.getBoard();
-  // picking an occupied position = always illegal
-  if (board[row][col] != Player::none) return false;
-
-  for (int i = 0; i < g_flipDirs.size(); i++) {
-    status = MoveCheckStatus::lookingForFlippable;
-    // get our direction values + current position
-    int dr = g_flipDirs[i].first;
-    int dc = g_flipDirs[i].second;
-    int r = row;
-    int c = col;
-
-    while (status != MoveCheckStatus::illegal) {
-      // advance one step
-      r += dr;
-      c += dc;
-
-      // out of bounds = illegal (haven't found a matching end-piece)
-      if (!inBounds(r, c)) {
-        status = MoveCheckStatus::illegal;
-      } else {
-        // get piece at current position
-        const Player& currPiece = board[r][c];
-        // if we found a blank, or one of our own pieces before finding
-        // one of the opponent's = illegal
-        if (currPiece == Player::none || (status == MoveCheckStatus::lookingForFlippable && currPiece == player)) {
-          status = MoveCheckStatus::illegal;
-        }
-        // if we found one of our own pieces after finding an opponent's
-        // end of a flipping streak = legal 
-        else if (currPiece == player) {
-          return true;
-        }
-        // if we found an opponent's piece, we switch to looking for
-        // our own (end of the streak)
-        else {
-          status = MoveCheckStatus::foundFlippable;
-        }
-      }
+// helper that finds the pieces a move at square move would flip
+template <int N>
+static Bitboard<N> flipsFor(Bitboard<N> move, Bitboard<N> own, Bitboard<N> opp) {
+  Bitboard<N> flips{0};
+
+  for (int dir = 0; dir < g_flipDirs.size(); dir++) {
+    Bitboard<N> run{0};
+    Bitboard<N> next = shiftDir<N>(move, dir);
+    while (next & opp) {
+      run |= next;
+      next = shiftDir<N>(next, dir);
     }
+    // only flippable if one of our own pieces closes off the run
+    if (next & own) flips |= run;
   }
-  // if we're here - we've exhausted all the move directions without
-  // finding one that would make (row, col) legal
-  return false; 
+  return flips;
 }
 
-const Othello& doMove(Othello& game, bool checkLegal, int row, int col) {
-  if (checkLegal && !isLegal(game, row, col)) {
-    std::cout << "\n!! Not gonna do an illegal move!\n";
-    return game;
+template <int N>
+Bitboard<N> legalMoveMask(const BasicOthello<N>& game) {
+  const Player& player = game.getWhoseTurn();
+  return player == Player::black
+    ? legalMoveMask<N>(game.getBlackPieces(), game.getWhitePieces())
+    : legalMoveMask<N>(game.getWhitePieces(), game.getBlackPieces());
+}
+
+template <int N>
+const BasicOthello<N>& doMove(BasicOthello<N>& game, bool checkLegal, int row, int col) {
+  if (checkLegal) {
+    Bitboard<N> moves{legalMoveMask(game)};
+    bool legal = isPass({row, col}) ? !moves
+      : inBounds<N>(row, col) && (moves & squareBit<N>(toPosn<N>(row, col)));
+    if (!legal) {
+      std::cout << "\n!! Not gonna do an illegal move!\n";
+      return game;
+    }
   }
   // passes shouldn't modify the game except for whose turn it is
   if (isPass({row, col})) {
@@ -66,65 +63,26 @@ const Othello& doMove(Othello& game, bool checkLegal, int row, int col) {
     return game;
   }
 
-  MoveCheckStatus status;
-  const Player& player = game.getWhoseTurn();
-  const std::array<std::array<Player, g_boardSize>, g_boardSize>& board = game.getBoard();
+  Player player = game.getWhoseTurn();
+  Player opponent = player == Player::black ? Player::white : Player::black;
+  Bitboard<N> flips{flipsFor<N>(squareBit<N>(toPosn<N>(row, col)), game.getPieces(player), game.getPieces(opponent))};
 
-  // place piece on the board
+  // place piece on the board, flip everything it captured
   game.placePiece(player, row, col);
+  game.flipPieces(player, flips);
 
-  for (int i = 0; i < g_flipDirs.size(); i++) {
-    status = MoveCheckStatus::lookingForFlippable;
-    // get our direction values + current position
-    int dr = g_flipDirs[i].first;
-    int dc = g_flipDirs[i].second;
-    int r = row;
-    int c = col;
-    std::vector<std::pair<int, int>> flippable;
-
-    while (status != MoveCheckStatus::doneChecking) {
-      // advance
-      r += dr;
-      c += dc;
-
-      // OOB - can't flip in this direction
-      if (!inBounds(r, c)) {
-        status = MoveCheckStatus::doneChecking;
-      } else {
-        const Player& currPiece = board[r][c];
-        // blank/found one of ours before theirs - stop looking in this dir
-        if (currPiece == Player::none || (status == MoveCheckStatus::lookingForFlippable && currPiece == player)) {
-          status = MoveCheckStatus::doneChecking;
-        }
-        // found another of our own pieces, surrounding a line of flippables - flip them!
-        else if (currPiece == player) {
-          for (int j = 0; j < flippable.size(); j++) {
-            game.flipPiece(player, flippable[j].first, flippable[j].second);
-          }
-          status = MoveCheckStatus::doneChecking;
-        }
-        // found one of their pieces to flip - keep looking
-        else {
-          flippable.push_back({r, c});
-          status = MoveCheckStatus::foundFlippable;
-        }
-      }
-    }
-  }
   // after flipping pieces, toggle player and return
   game.togglePlayer();
   return game;
 }
 
-const std::vector<std::pair<int, int>> legalMoves(const Othello& game) {
+template <int N>
+std::vector<std::pair<int, int>> movesFromMask(Bitboard<N> mask) {
   std::vector<std::pair<int, int>> moves;
-  // check every space for legal moves...
-  for (int i = 0; i < g_boardSize; i++) {
-    for (int j = 0; j < g_boardSize; j++) {
-      if (isLegal(game, i, j)) {
-        moves.push_back({i, j});
-      }
-    }
+  // lowest bit first = same row by row order as scanning the board
+  for (; mask; mask &= mask - Bitboard<N>{1}) {
+    int posn = lowestBit(mask);
+    moves.push_back({toRow<N>(posn), toCol<N>(posn)});
   }
   // if no legal moves, must pass
   if (!moves.size()) {
@@ -133,55 +91,47 @@ const std::vector<std::pair<int, int>> legalMoves(const Othello& game) {
   return moves;
 }
 
-// helper to determine if a function has any legal move and stops early - faster than waiting for legalMoves
-static bool hasLegalMove(const Othello& game) {
-  for (int i = 0; i < g_boardSize; i++) {
-    for (int j = 0; j < g_boardSize; j++) {
-      if (isLegal(game, i, j)) return true;
-    }
-  }
-  return false;
-}
-
-static bool mustPass(Othello& game, const Player& player) {
-  // if it's our turn, just check
-  if (player == game.getWhoseTurn())
-    return !hasLegalMove(game);
-  // if it's their turn, switch turns and check
-  else {
-    game.togglePlayer();
-    bool answer = !hasLegalMove(game);
-    game.togglePlayer();
-    return answer;
-  }
+template <int N>
+const std::vector<std::pair<int, int>> legalMoves(const BasicOthello<N>& game) {
+  return movesFromMask<N>(legalMoveMask(game));
 }
 
-bool isGameOver(Othello& game) {
+template <int N>
+bool isGameOver(const BasicOthello<N>& game) {
+  const Bitboard<N>& white = game.getWhitePieces();
+  const Bitboard<N>& black = game.getBlackPieces();
   // no more open spaces or both players have no legal moves
   return game.getNumOpen() == 0
-    || (mustPass(game, Player::black) && mustPass(game, Player::white));
+    || (!legalMoveMask<N>(black, white) && !legalMoveMask<N>(white, black));
 }
 
-static std::pair<int, int> randomMove(const Othello& game) {
-  std::vector<std::pair<int, int>> moves{legalMoves(game)};
-
-	static std::random_device rd;	// a seed source for the random number engine
-	static std::mt19937 gen(rd());	// mersenne_twister_engine seeded with rd()
-	std::uniform_int_distribution<> distrib(0, moves.size() - 1);
-
-  return moves[distrib(gen)];
+template <int N>
+std::pair<int, int> randomMove(Bitboard<N> moves, Rng& rng) {
+  if (!moves) return g_movePass;
+  // drop the lowest bits until the chosen one is at the bottom
+  for (int skip = rng.bounded(popCount(moves)); skip > 0; skip--)
+    moves &= moves - Bitboard<N>{1};
+  int posn = lowestBit(moves);
+  return {toRow<N>(posn), toCol<N>(posn)};
 }
 
-// helper used by defaultPolicy
-static const Othello& doRandomMove(Othello& game) {
-  // pick a random move and do it
-  std::pair<int, int> randMove{randomMove(game)};
-  return doMove(game, false, randMove.first, randMove.second);
-}
+template <int N>
+float defaultPolicy(BasicOthello<N>& game, Rng& rng) {
+  while (true) {
+    const Player& player = game.getWhoseTurn();
+    const Bitboard<N>& own = game.getPieces(player);
+    const Bitboard<N>& opp = game.getPieces(player == Player::black ? Player::white : Player::black);
+    Bitboard<N> moves{legalMoveMask<N>(own, opp)};
+
+    if (!moves) {
+      // neither side can move = game over, otherwise pass
+      if (!legalMoveMask<N>(opp, own)) break;
+      game.togglePlayer();
+      continue;
+    }
 
-float defaultPolicy(Othello& game) {
-  while (!isGameOver(game)) {
-    game = doRandomMove(game);
+    std::pair<int, int> move{randomMove<N>(moves, rng)};
+    doMove(game, false, move.first, move.second);
   }
 
   // compute score from pieces
@@ -197,22 +147,12 @@ float defaultPolicy(Othello& game) {
   else return 0;
 }
 
-// helper for debugging
-// static std::string printBinary(const uint64_t& number) {
-//   int counter = 0;
-//   uint64_t binary = number;
-//   std::string out;
-
-//   while (counter < 64) {
-//     if (binary & 1)
-//       out.push_back('1');
-//     else 
-//       out.push_back('0');
-//     binary >>= 1;
-//     counter++;
-//     if (counter % 8 == 0 && counter != 64)
-//       out.push_back('_');
-//   }
-//   std::reverse(out.begin(), out.end());
-//   return out;
-// }
\ No newline at end of file
+#define INSTANTIATE_RULES(N) \
+  template Bitboard<N> legalMoveMask(const BasicOthello<N>& game); \
+  template const BasicOthello<N>& doMove(BasicOthello<N>& game, bool checkLegal, int row, int col); \
+  template std::vector<std::pair<int, int>> movesFromMask<N>(Bitboard<N> mask); \
+  template const std::vector<std::pair<int, int>> legalMoves(const BasicOthello<N>& game); \
+  template bool isGameOver(const BasicOthello<N>& game); \
+  template std::pair<int, int> randomMove<N>(Bitboard<N> moves, Rng& rng); \
+  template float defaultPolicy(BasicOthello<N>& game, Rng& rng);
+OTHELLO_BOARD_SIZES(INSTANTIATE_RULES)
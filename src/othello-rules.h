@@ -3,6 +3,7 @@
 
 #include <vector>
 #include "othello.h"
+#include "rng.h"
 
 // the 4 up/down + 4 diagonal directions pieces can be flipped in
 constexpr std::array<std::pair<int, int>, 8> g_flipDirs{
@@ -16,24 +17,58 @@ constexpr std::array<std::pair<int, int>, 8> g_flipDirs{
     std::pair<int, int>{-1, -1}
 }; 
 
-// enum to keep track of the state of our legal move search
-enum class MoveCheckStatus
-{
-  lookingForFlippable,
-  foundFlippable,
-  doneChecking,
-  illegal
+// bit shift + mask that move every square one step in each of g_flipDirs on an N x N board
+// the mask drops squares that wrapped around to the other edge or fell off the board
+template <int N>
+struct DirShifts {
+  int shifts[g_flipDirs.size()];
+  Bitboard<N> masks[g_flipDirs.size()];
 };
 
+template <int N>
+constexpr DirShifts<N> makeDirShifts() {
+  DirShifts<N> dirs{};
+  for (int i = 0; i < g_flipDirs.size(); i++) {
+    int dr = g_flipDirs[i].first;
+    int dc = g_flipDirs[i].second;
+    dirs.shifts[i] = toPosn<N>(dr, dc);
+    // stepping right can't land in the first column, stepping left can't land in the last
+    dirs.masks[i] = dc == 1 ? notColMask<N>(0) : dc == -1 ? notColMask<N>(N - 1) : boardMask<N>();
+  }
+  return dirs;
+}
+
+// moves every piece in bits one step in direction g_flipDirs[dir]
+template <int N>
+inline Bitboard<N> shiftDir(Bitboard<N> bits, int dir) {
+  static constexpr DirShifts<N> dirs{makeDirShifts<N>()};
+  int shift = dirs.shifts[dir];
+  return (shift > 0 ? bits << shift : bits >> -shift) & dirs.masks[dir];
+}
+
+// returns one bit per square the current player can move to (0 = must pass)
+template <int N>
+Bitboard<N> legalMoveMask(const BasicOthello<N>& game);
 // execute a move and returns the updated game
 // if the move is illegal - prints an error and returns the unchanged game
-const Othello& doMove(Othello& game, bool checkLegal, int row, int col);
+template <int N>
+const BasicOthello<N>& doMove(BasicOthello<N>& game, bool checkLegal, int row, int col);
+// turns a move mask into a list of moves in row by row order, or just the pass move if it's empty
+// this order is what tree nodes, visit distributions and game records index moves by
+template <int N>
+std::vector<std::pair<int, int>> movesFromMask(Bitboard<N> mask);
 // returns a list of the legal moves for the current game state
-const std::vector<std::pair<int, int>> legalMoves(const Othello& game);
-// game isn't a const reference bc another function toggles the current turn twice to see if neither side can make a move
-bool isGameOver(Othello& game);
-// does random moves until the game is over
+template <int N>
+const std::vector<std::pair<int, int>> legalMoves(const BasicOthello<N>& game);
+// true once neither player has a legal move
+template <int N>
+bool isGameOver(const BasicOthello<N>& game);
+// picks one of the squares in moves uniformly at random, or the pass move if there are none
+template <int N>
+std::pair<int, int> randomMove(Bitboard<N> moves, Rng& rng);
+// does random moves drawn from rng until the game is over
 // and returns a score value = + for B win, - for W win
-float defaultPolicy(Othello& game);
+template <int N>
+float defaultPolicy(BasicOthello<N>& game, Rng& rng);
 
 #endif
\ No newline at end of file
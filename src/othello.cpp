@@ -1,3 +1,4 @@
+#include <functional>
 #include "othello.h"
 
 std::ostream& operator<< (std::ostream& out, const Player& player) {
@@ -9,18 +10,24 @@ std::ostream& operator<< (std::ostream& out, const Player& player) {
   return out;
 }
 
-Othello::Othello() {
-  std::array<int, 4> startingPieces{27, 36, 28, 35};
+template <int N>
+BasicOthello<N>::BasicOthello() {
+  // the middle 4 squares, white on the main diagonal
+  constexpr int mid{N / 2};
+  std::array<int, 4> startingPieces{
+    toPosn<N>(mid - 1, mid - 1), toPosn<N>(mid, mid),
+    toPosn<N>(mid - 1, mid), toPosn<N>(mid, mid - 1)
+  };
 
   // quick lambda so we don't have to overload Othello::placePiece
   auto setupPiece = [&](const Player& player, int posn) {
-    m_board[toRow(posn)][toCol(posn)] = player;
+    m_board[toRow<N>(posn)][toCol<N>(posn)] = player;
   };
 
   m_whoseTurn = Player::black;
-  m_numOpen = g_boardSize * g_boardSize - startingPieces.size();
-  m_whitePieces = (1Ui64 << startingPieces[0]) + (1Ui64 << startingPieces[1]);
-  m_blackPieces = (1Ui64 << startingPieces[2]) + (1Ui64 << startingPieces[3]);
+  m_numOpen = N * N - startingPieces.size();
+  m_whitePieces = squareBit<N>(startingPieces[0]) | squareBit<N>(startingPieces[1]);
+  m_blackPieces = squareBit<N>(startingPieces[2]) | squareBit<N>(startingPieces[3]);
 
   setupPiece(Player::white, startingPieces[0]);
   setupPiece(Player::white, startingPieces[1]);
@@ -28,93 +35,103 @@ Othello::Othello() {
   setupPiece(Player::black, startingPieces[3]);
 }
 
-void Othello::togglePlayer() {
-  if (m_whoseTurn == Player::black) m_whoseTurn = Player::white;
-  else if (m_whoseTurn == Player::white) m_whoseTurn = Player::black;
-}
+template <int N>
+BasicOthello<N>::BasicOthello(const std::array<std::array<Player, N>, N>& board, Player whoseTurn) {
+  m_whoseTurn = whoseTurn;
+  m_numOpen = N * N;
 
-static std::pair<int, int> countTotal(const std::array<std::array<Player, g_boardSize>, g_boardSize>& board) {
-  std::pair<int, int> counts{0, 0};
-
-  for (int r = 0; r < g_boardSize; r++) {
-    for (int c = 0; c < g_boardSize; c++) {
-      const Player& p = board[r][c];
-
-      if (p == Player::white) counts.first++;
-      else if (p == Player::black) counts.second++;
+  // placePiece keeps the bit vectors and open count in sync
+  for (int r = 0; r < N; r++) {
+    for (int c = 0; c < N; c++) {
+      if (board[r][c] != Player::none)
+        placePiece(board[r][c], r, c);
     }
   }
-  return counts;
 }
 
-const std::pair<int, int> Othello::getTotalPieces() {
-  return countTotal(m_board);
+template <int N>
+void BasicOthello<N>::togglePlayer() {
+  if (m_whoseTurn == Player::black) m_whoseTurn = Player::white;
+  else if (m_whoseTurn == Player::white) m_whoseTurn = Player::black;
 }
 
-const std::pair<int, int> Othello::getTotalPieces() const {
-  return countTotal(m_board);
+template <int N>
+const std::pair<int, int> BasicOthello<N>::getTotalPieces() const {
+  return {popCount(m_whitePieces), popCount(m_blackPieces)};
 }
 
-void Othello::placePiece(const Player& player, int row, int col) {
+template <int N>
+void BasicOthello<N>::placePiece(const Player& player, int row, int col) {
   m_board[row][col] = player;
   m_numOpen--;
-  int pieceBit = toPosn(row, col);
+  Bitboard<N> pieceBit{squareBit<N>(toPosn<N>(row, col))};
   if (player == Player::black)
-    m_blackPieces.set(pieceBit);
-  else 
-    m_whitePieces.set(pieceBit);
+    m_blackPieces |= pieceBit;
+  else
+    m_whitePieces |= pieceBit;
 }
 
-void Othello::flipPiece(const Player& player, int row, int col) {
-  m_board[row][col] = player;
-  int pieceBit = toPosn(row, col);
+template <int N>
+void BasicOthello<N>::flipPiece(const Player& player, int row, int col) {
+  flipPieces(player, squareBit<N>(toPosn<N>(row, col)));
+}
+
+template <int N>
+void BasicOthello<N>::flipPieces(const Player& player, Bitboard<N> flips) {
   if (player == Player::black) {
-    m_blackPieces.set(pieceBit);
-    m_whitePieces.reset(pieceBit);
+    m_blackPieces |= flips;
+    m_whitePieces &= ~flips;
   } else {
-    m_whitePieces.set(pieceBit);
-    m_blackPieces.reset(pieceBit);
+    m_whitePieces |= flips;
+    m_blackPieces &= ~flips;
   }
-}
 
-const Player& Othello::operator()(int row, int col) {
-  return m_board[row][col];
+  // keep the board array in sync one square at a time
+  while (flips) {
+    int posn = lowestBit(flips);
+    m_board[toRow<N>(posn)][toCol<N>(posn)] = player;
+    flips &= flips - Bitboard<N>{1};
+  }
 }
 
-std::ostream& operator<< (std::ostream& out, const Othello& game) {
+template <int N>
+std::ostream& operator<<(std::ostream& out, const BasicOthello<N>& game) {
   out << "\n |";
-  for (int i = 0; i < g_boardSize; i++) { out << " " << i; }
-  out << "\n------------------\n";
-  for (int r = 0; r < g_boardSize; r++) {
+  for (int i = 0; i < N; i++) { out << " " << i; }
+  out << "\n" << std::string(2 * N + 2, '-') << "\n";
+  for (int r = 0; r < N; r++) {
     out << r << "| ";
-    for (int c = 0; c < g_boardSize; c++) {
-      out << game.m_board[r][c] << " ";
+    for (int c = 0; c < N; c++) {
+      out << game(r, c) << " ";
     }
     out << "\n";
   }
-  out << "\nIt is " << game.m_whoseTurn << "'s turn!\n";
-  out << "  white: " << game.m_whitePieces << "\n";
-  out << "  black: " << game.m_blackPieces << "\n";
-  // 
+  out << "\nIt is " << game.getWhoseTurn() << "'s turn!\n";
+  out << "  white: " << toBinary<N>(game.getWhitePieces()) << "\n";
+  out << "  black: " << toBinary<N>(game.getBlackPieces()) << "\n";
+  //
   std::pair<int, int> pieces{game.getTotalPieces()};
-  out << "  num-white: " << pieces.first 
+  out << "  num-white: " << pieces.first
       << ", num-black: " << pieces.second << "\n";
-      
+
   return out;
 }
 
-static size_t computeHash(std::bitset<64> white, std::bitset<64> black, Player whoseTurn) {
-  size_t hashW = std::hash<std::bitset<64>>{}(white);
-  size_t hashB = std::hash<std::bitset<64>>{}(black);
+template <int N>
+static size_t computeHash(Bitboard<N> white, Bitboard<N> black, Player whoseTurn) {
+  size_t hashW = hashBits(white);
+  size_t hashB = hashBits(black);
   size_t hashTurn = std::hash<int>{}(static_cast<int>(whoseTurn));
   // could have used boost::combine idk
   return hashW ^ (hashB << 1) ^ (hashTurn << 2);
 }
 
-size_t Othello::getHashKey() {
-  return computeHash(m_whitePieces, m_blackPieces, m_whoseTurn);
+template <int N>
+size_t BasicOthello<N>::getHashKey() const {
+  return computeHash<N>(m_whitePieces, m_blackPieces, m_whoseTurn);
 }
 
-size_t Othello::getHashKey() const {
-  return computeHash(m_whitePieces, m_blackPieces, m_whoseTurn);
-}
\ No newline at end of file
+#define INSTANTIATE_OTHELLO(N) \
+  template class BasicOthello<N>; \
+  template std::ostream& operator<<(std::ostream& out, const BasicOthello<N>& game);
+OTHELLO_BOARD_SIZES(INSTANTIATE_OTHELLO)
@@ -4,13 +4,17 @@
 #include <iostream>
 #include <utility>
 #include <array>
-#include <bitset>
+#include "bitboard.h"
 
-// size/# of spaces in one dimension of the board
+// size/# of spaces in one dimension of the default board
 constexpr int g_boardSize{8};
 // the "pass" move with OOB row/col
 constexpr std::pair<int, int> g_movePass{99, 99};
 
+// calls X(N) for every board size the engine is compiled for
+// the .cpp files use this to explicitly instantiate their templates, so adding a size here is all it takes
+#define OTHELLO_BOARD_SIZES(X) X(6) X(8) X(10)
+
 // enum representing the types of pieces on the board
 enum class Player {
   none,
@@ -20,51 +24,69 @@ enum class Player {
 
 std::ostream& operator<< (std::ostream& out, const Player& player);
 
-class Othello {
+// an N x N game - every size gets its own fully specialized copy of the engine
+template <int N>
+class BasicOthello {
+  static_assert(N >= 4 && N % 2 == 0, "board size must be even and at least 4");
+  static_assert(N * N <= 128, "boards bigger than 11x11 don't fit in a bitboard");
+
   private:
     // SIZE^2 array of spaces, initially unoccupied
-    std::array<std::array<Player, g_boardSize>, g_boardSize> m_board{ Player::none };
+    std::array<std::array<Player, N>, N> m_board{};
     // either black or white
     Player m_whoseTurn;
     // bits representing occupied positions on the board
-    std::bitset<64> m_whitePieces, m_blackPieces;
+    Bitboard<N> m_whitePieces{0}, m_blackPieces{0};
     // number of unoccupied spaces, <= boardSize - 4 starting pieces
     int m_numOpen;
   public:
-    Othello();
-    const std::array<std::array<Player, g_boardSize>, g_boardSize>& getBoard() { return m_board; }
-    const std::array<std::array<Player, g_boardSize>, g_boardSize>& getBoard() const { return m_board; }
-    const Player& getWhoseTurn() { return m_whoseTurn; }
+    BasicOthello();
+    // set up an arbitrary position from a board and the side to move
+    BasicOthello(const std::array<std::array<Player, N>, N>& board, Player whoseTurn);
+    const std::array<std::array<Player, N>, N>& getBoard() const { return m_board; }
     const Player& getWhoseTurn() const { return m_whoseTurn; }
     // swap w/b as current player
     void togglePlayer();
-    const std::bitset<64>& getWhitePieces() { return m_whitePieces; }
-    const std::bitset<64>& getBlackPieces() { return m_blackPieces; }
+    const Bitboard<N>& getWhitePieces() const { return m_whitePieces; }
+    const Bitboard<N>& getBlackPieces() const { return m_blackPieces; }
+    // bits for the given player's pieces
+    const Bitboard<N>& getPieces(const Player& player) const {
+      return player == Player::black ? m_blackPieces : m_whitePieces;
+    }
     // returns (w, b) sum of pieces on board
-    const std::pair<int, int> getTotalPieces();
     const std::pair<int, int> getTotalPieces() const;
-    int getNumOpen() { return m_numOpen; }
+    int getNumOpen() const { return m_numOpen; }
     // place piece at board[row, col] and update player bit vector
     void placePiece(const Player& player, int row, int col);
     // flip piece at board[row, col] and update both bit vectors
     void flipPiece(const Player& player, int row, int col);
+    // flip every piece in flips over to player
+    void flipPieces(const Player& player, Bitboard<N> flips);
     // get player at position (row, col)
-    const Player& operator()(int row, int col);
-    friend std::ostream& operator<<(std::ostream& out, const Othello& game);
+    const Player& operator()(int row, int col) const { return m_board[row][col]; }
 
-    size_t getHashKey();
     size_t getHashKey() const;
 };
 
+// the standard 8x8 game
+using Othello = BasicOthello<g_boardSize>;
+
+template <int N>
+std::ostream& operator<<(std::ostream& out, const BasicOthello<N>& game);
+
 // convert bit posn 0-boardSize to board row
-inline int toRow(int posn) { return posn / g_boardSize; }
+template <int N = g_boardSize>
+constexpr int toRow(int posn) { return posn / N; }
 // convert bit posn 0-boardSize to board col
-inline int toCol(int posn) { return posn % g_boardSize; }
+template <int N = g_boardSize>
+constexpr int toCol(int posn) { return posn % N; }
 // convert board [row, col] to bit posn 0-boardSize
-inline int toPosn(int row, int col) { return row * g_boardSize + col; }
+template <int N = g_boardSize>
+constexpr int toPosn(int row, int col) { return row * N + col; }
 // determine whether move is = pass move constant
 inline bool isPass(std::pair<int, int> move) { return move == g_movePass; }
-// determine whether [row, col] is in bounds 
-inline bool inBounds(int row, int col) { return row >= 0 && row < g_boardSize && col >= 0 && col < g_boardSize; }
+// determine whether [row, col] is in bounds
+template <int N = g_boardSize>
+constexpr bool inBounds(int row, int col) { return row >= 0 && row < N && col >= 0 && col < N; }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,286 @@
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include "record.h"
+#include "othello-rules.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// size of the fixed part of a game record (everything before the moves, minus the size field)
+constexpr size_t g_recordGameHeaderSize{33};
+
+uint8_t toRecordSquare(const std::pair<int, int>& move, int boardSize) {
+  return isPass(move) ? g_recordPass : move.first * boardSize + move.second;
+}
+
+std::pair<int, int> fromRecordSquare(uint8_t square, int boardSize) {
+  return square == g_recordPass ? g_movePass : std::pair<int, int>{square / boardSize, square % boardSize};
+}
+
+// little-endian helpers so files are portable between machines
+static void put8(std::vector<char>& out, uint8_t value) { out.push_back(static_cast<char>(value)); }
+
+static void put16(std::vector<char>& out, uint16_t value) {
+  put8(out, value & 0xff);
+  put8(out, value >> 8);
+}
+
+static void put32(std::vector<char>& out, uint32_t value) {
+  for (int i = 0; i < 4; i++)
+    put8(out, (value >> (8 * i)) & 0xff);
+}
+
+static void putFloat(std::vector<char>& out, float value) {
+  uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  put32(out, bits);
+}
+
+static void put64(std::vector<char>& out, uint64_t value) {
+  put32(out, value & 0xffffffff);
+  put32(out, value >> 32);
+}
+
+static uint16_t get16(const uint8_t* in) { return in[0] | (in[1] << 8); }
+
+static uint32_t get32(const uint8_t* in) {
+  return in[0] | (in[1] << 8) | (in[2] << 16) | (static_cast<uint32_t>(in[3]) << 24);
+}
+
+static uint64_t get64(const uint8_t* in) { return get32(in) | (static_cast<uint64_t>(get32(in + 4)) << 32); }
+
+static float getFloat(const uint8_t* in) {
+  uint32_t bits{get32(in)};
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+static void encodeGame(std::vector<char>& out, const GameRecord& game) {
+  bool hasVisits = !game.visits.empty();
+  // leave room for the size field and fill it in at the end
+  size_t start = out.size();
+  put32(out, 0);
+
+  put32(out, game.blackSims);
+  putFloat(out, game.blackC);
+  put32(out, game.whiteSims);
+  putFloat(out, game.whiteC);
+  put8(out, game.pieces.first);
+  put8(out, game.pieces.second);
+  put8(out, hasVisits ? g_recordHasVisits : 0);
+  put16(out, game.moves.size());
+  put32(out, game.index);
+  put64(out, game.seed);
+  out.insert(out.end(), game.moves.begin(), game.moves.end());
+
+  if (hasVisits) {
+    for (const std::vector<int>& moveVisits : game.visits) {
+      put8(out, moveVisits.size());
+      for (int visits : moveVisits)
+        put32(out, visits);
+    }
+  }
+
+  uint32_t size = out.size() - start - 4;
+  for (int i = 0; i < 4; i++)
+    out[start + i] = static_cast<char>((size >> (8 * i)) & 0xff);
+}
+
+GameRecordWriter::GameRecordWriter(const std::string& path, int boardSize) : m_path(path), m_boardSize(boardSize) {
+  // games get added after whatever is already in the file, as long as it's the same kind of file
+  std::ifstream existing{path, std::ios::binary | std::ios::ate};
+  bool hasHeader = existing && existing.tellg() > 0;
+  if (hasHeader) {
+    uint8_t header[g_recordHeaderSize];
+    existing.seekg(0);
+    if (!existing.read(reinterpret_cast<char*>(header), g_recordHeaderSize)
+        || std::memcmp(header, g_recordMagic, 4) != 0 || get32(header + 4) != g_recordVersion
+        || get32(header + 8) != static_cast<uint32_t>(boardSize)) {
+      throw std::runtime_error(path + " isn't a version " + std::to_string(g_recordVersion) + " record file for "
+        + std::to_string(boardSize) + "x" + std::to_string(boardSize) + " games!");
+    }
+  }
+  existing.close();
+
+  m_file.open(path, std::ios::binary | std::ios::app);
+  if (!m_file)
+    throw std::runtime_error("Couldn't open " + path + " for writing!");
+
+  m_buffer.reserve(g_recordFlushSize * 2);
+  if (!hasHeader) {
+    m_buffer.insert(m_buffer.end(), g_recordMagic, g_recordMagic + 4);
+    put32(m_buffer, g_recordVersion);
+    put32(m_buffer, boardSize);
+  }
+}
+
+GameRecordWriter::~GameRecordWriter() {
+  // a broken stream was already reported by the append/flush that found it
+  if (!m_file) return;
+  // can't throw from here - at least say the last games didn't make it
+  try {
+    flush();
+  } catch (const std::runtime_error& err) {
+    std::cerr << err.what() << "\n";
+  }
+}
+
+void GameRecordWriter::flushLocked() {
+  m_file.write(m_buffer.data(), m_buffer.size());
+  m_buffer.clear();
+  if (!m_file)
+    throw std::runtime_error("Couldn't write games to " + m_path + "!");
+}
+
+void GameRecordWriter::append(const GameRecord& game) {
+  std::vector<char> encoded;
+  encodeGame(encoded, game);
+
+  std::lock_guard<std::mutex> lock{m_mutex};
+  m_buffer.insert(m_buffer.end(), encoded.begin(), encoded.end());
+  if (m_buffer.size() >= g_recordFlushSize)
+    flushLocked();
+}
+
+void GameRecordWriter::flush() {
+  std::lock_guard<std::mutex> lock{m_mutex};
+  flushLocked();
+  m_file.flush();
+  if (!m_file)
+    throw std::runtime_error("Couldn't write games to " + m_path + "!");
+}
+
+GameRecordReader::GameRecordReader(const std::string& path) {
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE)
+    throw std::runtime_error("Couldn't open " + path + "!");
+  LARGE_INTEGER size;
+  GetFileSizeEx(file, &size);
+  m_fileHandle = file;
+  m_size = size.QuadPart;
+  if (m_size >= g_recordHeaderSize) {
+    m_mapHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapHandle)
+      m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapHandle, FILE_MAP_READ, 0, 0, 0));
+  }
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    throw std::runtime_error("Couldn't open " + path + "!");
+  struct stat info;
+  fstat(fd, &info);
+  m_size = info.st_size;
+  if (m_size >= g_recordHeaderSize) {
+    void* mapped = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped != MAP_FAILED) {
+      m_data = static_cast<const uint8_t*>(mapped);
+      // games are read front to back
+      madvise(mapped, m_size, MADV_SEQUENTIAL);
+    }
+  }
+  // the mapping stays valid after the descriptor is closed
+  close(fd);
+#endif
+
+  if (!m_data || std::memcmp(m_data, g_recordMagic, 4) != 0 || get32(m_data + 4) != g_recordVersion) {
+    unmap();
+    throw std::runtime_error(path + " isn't a version " + std::to_string(g_recordVersion) + " record file!");
+  }
+  m_boardSize = get32(m_data + 8);
+}
+
+GameRecordReader::~GameRecordReader() { unmap(); }
+
+void GameRecordReader::unmap() {
+#ifdef _WIN32
+  if (m_data) UnmapViewOfFile(m_data);
+  if (m_mapHandle) CloseHandle(m_mapHandle);
+  if (m_fileHandle) CloseHandle(m_fileHandle);
+  m_mapHandle = m_fileHandle = nullptr;
+#else
+  if (m_data) munmap(const_cast<uint8_t*>(m_data), m_size);
+#endif
+  m_data = nullptr;
+}
+
+bool GameRecordReader::next(GameRecordView& game) {
+  if (m_offset == m_size) return false;
+
+  auto truncated = [&]() {
+    return std::runtime_error("Truncated game record at byte " + std::to_string(m_offset) + "!");
+  };
+  if (m_size - m_offset < 4) throw truncated();
+  size_t size = get32(m_data + m_offset);
+  if (size < g_recordGameHeaderSize || m_size - m_offset - 4 < size) throw truncated();
+
+  const uint8_t* in = m_data + m_offset + 4;
+  game.boardSize = m_boardSize;
+  game.blackSims = get32(in);
+  game.blackC = getFloat(in + 4);
+  game.whiteSims = get32(in + 8);
+  game.whiteC = getFloat(in + 12);
+  game.pieces = {in[16], in[17]};
+  uint8_t flags = in[18];
+  game.numMoves = get16(in + 19);
+  game.index = get32(in + 21);
+  game.seed = get64(in + 25);
+  if (g_recordGameHeaderSize + game.numMoves > size) throw truncated();
+  game.moves = in + g_recordGameHeaderSize;
+  // replayGame trusts the squares, so anything off the board would be written straight past it
+  for (int ply = 0; ply < game.numMoves; ply++) {
+    if (game.moves[ply] != g_recordPass && game.moves[ply] >= m_boardSize * m_boardSize)
+      throw std::runtime_error("Bad move square " + std::to_string(game.moves[ply]) + " in game record at byte " + std::to_string(m_offset) + "!");
+  }
+  game.visits = flags & g_recordHasVisits ? game.moves + game.numMoves : nullptr;
+
+  // make sure the visit distributions fit so replayGame doesn't have to check
+  if (game.visits) {
+    const uint8_t* visits = game.visits;
+    const uint8_t* end = in + size;
+    for (int ply = 0; ply < game.numMoves; ply++) {
+      if (visits >= end) throw truncated();
+      visits += 1 + 4 * *visits;
+    }
+    if (visits > end) throw truncated();
+  }
+
+  m_offset += 4 + size;
+  return true;
+}
+
+template <int N>
+BasicOthello<N> replayGame(const GameRecordView& game, int numPlies, std::vector<std::vector<int>>* visitsOut) {
+  if (game.boardSize != N)
+    throw std::invalid_argument("Game was played on a " + std::to_string(game.boardSize) + "x" + std::to_string(game.boardSize) + " board!");
+  if (numPlies < 0 || numPlies > game.numMoves)
+    numPlies = game.numMoves;
+
+  BasicOthello<N> replay;
+  const uint8_t* visits = game.visits;
+  for (int ply = 0; ply < numPlies; ply++) {
+    if (visitsOut && visits) {
+      int numLegal = *visits++;
+      std::vector<int> moveVisits(numLegal);
+      for (int i = 0; i < numLegal; i++, visits += 4)
+        moveVisits[i] = get32(visits);
+      visitsOut->push_back(moveVisits);
+    }
+
+    std::pair<int, int> move{game.getMove(ply)};
+    doMove(replay, false, move.first, move.second);
+  }
+  return replay;
+}
+
+#define INSTANTIATE_RECORD(N) \
+  template BasicOthello<N> replayGame(const GameRecordView& game, int numPlies, std::vector<std::vector<int>>* visitsOut);
+OTHELLO_BOARD_SIZES(INSTANTIATE_RECORD)
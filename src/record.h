@@ -0,0 +1,127 @@
+#ifndef RECORD_H
+#define RECORD_H
+
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "othello.h"
+
+// record files start with this magic + little-endian uint32 version and board size, followed by the games back to back
+constexpr char g_recordMagic[4]{'O', 'R', 'E', 'C'};
+constexpr uint32_t g_recordVersion{3};
+constexpr size_t g_recordHeaderSize{12};
+// move square used for passes (real squares are row * boardSize + col)
+constexpr uint8_t g_recordPass{255};
+// set in a game's flags when it carries root visit distributions
+constexpr uint8_t g_recordHasVisits{1};
+// the writer hands its buffer to the OS once it grows past this many bytes
+constexpr size_t g_recordFlushSize{1 << 16};
+
+// in-memory form of one game, used for writing
+// each game is stored as:
+//   uint32 size of the rest of the record
+//   uint32 blackSims, float blackC, uint32 whiteSims, float whiteC
+//   uint8 white pieces, uint8 black pieces, uint8 flags, uint16 numMoves
+//   uint32 index, uint64 seed
+//   numMoves bytes of move squares
+//   if g_recordHasVisits: per move, uint8 numLegal then numLegal uint32 visit counts
+struct GameRecord {
+  int blackSims = 0;
+  float blackC = 0;
+  int whiteSims = 0;
+  float whiteC = 0;
+  // (w, b) final piece counts
+  std::pair<int, int> pieces{0, 0};
+  // which game of its self-play run this was, and the seed playGame was given for it
+  // games are stored in the order they finish, so these are what tie a record back to its run
+  uint32_t index = 0;
+  uint64_t seed = 0;
+  std::vector<uint8_t> moves;
+  // root visits for each legal move (in legalMoves order) before every move - leave empty to skip them
+  std::vector<std::vector<int>> visits;
+};
+
+// convert a move to its record square and back
+uint8_t toRecordSquare(const std::pair<int, int>& move, int boardSize);
+std::pair<int, int> fromRecordSquare(uint8_t square, int boardSize);
+
+// append-only writer that can be shared between self-play threads
+// games are encoded outside the lock and only copied into the shared buffer under it
+class GameRecordWriter {
+  private:
+    std::ofstream m_file;
+    std::string m_path;
+    int m_boardSize;
+    std::vector<char> m_buffer;
+    std::mutex m_mutex;
+    // write out the buffer - caller must hold m_mutex
+    // throws std::runtime_error if the write fails
+    void flushLocked();
+  public:
+    // every game in the file must be played on a boardSize x boardSize board
+    // games are appended to an existing file, which must have been written for the same version and boardSize
+    // throws std::runtime_error if the file can't be opened or doesn't match
+    GameRecordWriter(const std::string& path, int boardSize);
+    ~GameRecordWriter();
+    GameRecordWriter(const GameRecordWriter&) = delete;
+    GameRecordWriter& operator=(const GameRecordWriter&) = delete;
+    int getBoardSize() const { return m_boardSize; }
+    // append and flush throw std::runtime_error if the games can't be written out
+    void append(const GameRecord& game);
+    void flush();
+};
+
+// one game inside a mapped record file
+// moves and visits point straight into the mapping, so a view is only valid while its reader is alive
+struct GameRecordView {
+  int boardSize;
+  int blackSims;
+  float blackC;
+  int whiteSims;
+  float whiteC;
+  std::pair<int, int> pieces;
+  uint32_t index;
+  uint64_t seed;
+  int numMoves;
+  const uint8_t* moves;
+  // start of the visit distributions, nullptr if the game has none
+  const uint8_t* visits;
+
+  std::pair<int, int> getMove(int ply) const { return fromRecordSquare(moves[ply], boardSize); }
+};
+
+// memory-maps a record file and walks through its games without copying them
+class GameRecordReader {
+  private:
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    size_t m_offset = g_recordHeaderSize;
+    int m_boardSize = 0;
+#ifdef _WIN32
+    void* m_fileHandle = nullptr;
+    void* m_mapHandle = nullptr;
+#endif
+    void unmap();
+  public:
+    // throws std::runtime_error if the file can't be mapped or isn't a record file
+    GameRecordReader(const std::string& path);
+    ~GameRecordReader();
+    GameRecordReader(const GameRecordReader&) = delete;
+    GameRecordReader& operator=(const GameRecordReader&) = delete;
+    int getBoardSize() const { return m_boardSize; }
+    // fills game with the next record and returns true, or returns false once there are none left
+    // throws std::runtime_error if the record is truncated or has a move square that isn't on the board
+    bool next(GameRecordView& game);
+    // start again from the first game
+    void rewind() { m_offset = g_recordHeaderSize; }
+};
+
+// replays the first numPlies moves of a recorded game (all of them if numPlies < 0) through doMove
+// if visitsOut is given, it's filled with the root visits recorded before each replayed move
+// throws std::invalid_argument if the game wasn't played on an N x N board
+template <int N = g_boardSize>
+BasicOthello<N> replayGame(const GameRecordView& game, int numPlies = -1, std::vector<std::vector<int>>* visitsOut = nullptr);
+
+#endif
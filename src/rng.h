@@ -0,0 +1,60 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <cstdint>
+
+// splitmix64 step - used to expand seeds, and good at turning nearby seeds into unrelated ones
+inline uint64_t splitMix(uint64_t& state) {
+  uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// derive an independent seed for the index-th search/game/position from a base seed
+inline uint64_t mixSeed(uint64_t seed, uint64_t index) {
+  uint64_t state = seed ^ splitMix(index);
+  return splitMix(state);
+}
+
+// xoshiro256** generator - a few shifts and adds per draw, so it's cheap enough to call once per playout move
+// not thread-safe: give every search thread its own, seeded from the search seed
+class Rng {
+  private:
+    uint64_t m_state[4];
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+  public:
+    explicit Rng(uint64_t seed) {
+      for (uint64_t& s : m_state)
+        s = splitMix(seed);
+    }
+
+    uint64_t next() {
+      uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+      uint64_t t = m_state[1] << 17;
+      m_state[2] ^= m_state[0];
+      m_state[3] ^= m_state[1];
+      m_state[1] ^= m_state[2];
+      m_state[0] ^= m_state[3];
+      m_state[2] ^= t;
+      m_state[3] = rotl(m_state[3], 45);
+      return result;
+    }
+
+    // unbiased draw in [0, bound) using Lemire's multiply-shift
+    // the modulo for the rejection threshold only runs on the ~bound/2^32 chance the first draw lands in the biased zone
+    uint32_t bounded(uint32_t bound) {
+      uint64_t m = (next() >> 32) * bound;
+      uint32_t low = static_cast<uint32_t>(m);
+      if (low < bound) {
+        uint32_t threshold = (0 - bound) % bound;
+        while (low < threshold) {
+          m = (next() >> 32) * bound;
+          low = static_cast<uint32_t>(m);
+        }
+      }
+      return m >> 32;
+    }
+};
+
+#endif